@@ -3,6 +3,10 @@
 #include <vector>
 #include <cmath>
 #include <chrono>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <initializer_list>
 #define RESET_CODE   "\033[0m"
 #define GREEN_CODE   "\033[32m"      /* Green */
 #define MAGENTA_CODE "\033[35m"      /* Magenta */
@@ -14,14 +18,22 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <termios.h>
+#include <csignal>
+#include <sys/select.h>
+static volatile sig_atomic_t terminalResized = 0; /* set by SIGWINCH */
+static sigset_t resizeWaitMask; /* signal mask with SIGWINCH unblocked, used only while waiting for input */
+/* Returns EOF without reading when a SIGWINCH arrives while waiting for a key */
 int getch() {
     struct termios oldt{}, newt{};
-    int ch;
+    int ch = EOF;
     tcgetattr(STDIN_FILENO, &oldt);
     newt = oldt;
     newt.c_lflag &= ~(ICANON | ECHO);
     tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    ch = getchar();
+    fd_set input;
+    FD_ZERO(&input);
+    FD_SET(STDIN_FILENO, &input);
+    if (pselect(STDIN_FILENO + 1, &input, nullptr, nullptr, nullptr, &resizeWaitMask) > 0) ch = getchar();
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
     return ch;
 }
@@ -30,6 +42,7 @@ using namespace std;
 
 static int SCREEN_HEIGHT;
 static int SCREEN_WIDTH;
+static unsigned layoutGeneration = 0; /* bumped on every terminal resize */
 
 class Color {
 public:
@@ -69,6 +82,7 @@ public:
         }
         return NOTHING;
 #else
+        if (terminalResized) return NOTHING; // SIGWINCH is blocked here, so nothing can slip in before getch()
         int input = getch();
         switch (input) {
             case 65: // up
@@ -89,6 +103,79 @@ public:
 #endif
     }
 };
+/* Screen text laid out in a fixed arena of cells, refilled every frame without heap allocations */
+class TextLayout {
+public:
+    static const size_t CAPACITY = 4096;
+    static const size_t MAX_LINES = 64;
+    struct Span {
+        const char *data;
+        size_t length;
+        [[nodiscard]] size_t size() const { return length; }
+    };
+    void clear() {
+        used = 0;
+        count = 0;
+    }
+    void assign(initializer_list<const char *> items) {
+        clear();
+        for (auto item: items) addLine(item);
+    }
+    void addLine(const char *text) {
+        if (count == MAX_LINES) return;
+        const size_t length = min(strlen(text), CAPACITY - used);
+        memcpy(cells + used, text, length);
+        pushLine(length);
+    }
+    void addFormat(const char *format, ...) {
+        if (count == MAX_LINES) return;
+        va_list args;
+        va_start(args, format);
+        const size_t length = formatAt(cells + used, CAPACITY - used, format, args);
+        va_end(args);
+        pushLine(length);
+    }
+    /* Formats over an existing line starting at column, clipped to the line length.
+     * Like sprintf over a fixed-width string, shorter output ends in a '\0' cell, which is drawn blank */
+    void print(size_t line, size_t column, const char *format, ...) {
+        if (line >= count || column >= lines[line].length) return;
+        char *end = cells + lines[line].offset + lines[line].length;
+        const char saved = *end;
+        va_list args;
+        va_start(args, format);
+        formatAt(cells + lines[line].offset + column, lines[line].length - column, format, args);
+        va_end(args);
+        *end = saved;
+    }
+    void put(size_t line, size_t column, char c) {
+        if (line < count && column < lines[line].length) cells[lines[line].offset + column] = c;
+    }
+    [[nodiscard]] size_t size() const { return count; }
+    Span operator[](size_t line) const {
+        if (line >= count) return {cells, 0};
+        return {cells + lines[line].offset, lines[line].length};
+    }
+private:
+    struct Line {
+        size_t offset;
+        size_t length;
+    };
+    char cells[CAPACITY + 1]{}; // one spare cell for vsnprintf's terminator
+    Line lines[MAX_LINES]{};
+    size_t used = 0;
+    size_t count = 0;
+
+    /* Formats straight into at most room cells, the terminator goes one past them */
+    static size_t formatAt(char *to, size_t room, const char *format, va_list args) {
+        const int written = vsnprintf(to, room + 1, format, args);
+        if (written < 0) return 0;
+        return min(static_cast<size_t>(written), room);
+    }
+    void pushLine(size_t length) {
+        lines[count++] = {used, length};
+        used += length;
+    }
+};
 enum ScreenIds {
     MENU = 0,
     TABLE,
@@ -103,11 +190,19 @@ ScreenIds screenId = ScreenIds::MENU;
 class Screen {
 protected:
     vector<vector<char>> canvas;
-    vector<string> menuItems;
+    TextLayout menuItems;
 
-    size_t yStart;
-    size_t xStart;
+    ptrdiff_t yStart;
+    ptrdiff_t xStart;
+private:
+    unsigned layoutVersion = 0;
 public:
+    /* Re-lays out the screen only if the terminal was resized since its last layout */
+    void refreshLayout() {
+        if (layoutVersion == layoutGeneration) return;
+        layoutVersion = layoutGeneration;
+        relayout();
+    }
     virtual void render() {
         switch (Buttons::getKeyCode()) {
             case (Buttons::Keys::ESC):
@@ -143,41 +238,49 @@ public:
 
 protected:
     void configureScreen() {
-        canvas = generateCanvas();
+        resizeCanvas(canvas);
         fillMenuItems();
         calculateCords();
         drawMenuItems();
     }
     static vector<vector<char>> generateCanvas() {
         vector<vector<char>> canvas1;
-        canvas1.resize(SCREEN_HEIGHT);
-        for (auto &i: canvas1) i.resize(SCREEN_WIDTH);
+        resizeCanvas(canvas1);
         return canvas1;
     }
+    /* Clears the canvas and fits it to the current screen size, reusing row storage */
+    static void resizeCanvas(vector<vector<char>> &canvas1) {
+        canvas1.resize(SCREEN_HEIGHT);
+        for (auto &i: canvas1) i.assign(SCREEN_WIDTH, 0);
+    }
+    /* Moves the already formatted menuItems onto the resized canvas */
+    virtual void relayout() {
+        resizeCanvas(canvas);
+        calculateCords();
+        drawMenuItems();
+    }
+    /* Blits every line as one span clipped to the canvas; yStart and xStart may be negative */
     virtual void drawMenuItems() {
-        for (int i = 0; i < menuItems.size(); i++) {
-            for (int j = 0; j < menuItems[i].size(); j++) {
-                if (
-                        i + yStart < canvas.size() &&
-                        i + yStart >= 0 &&
-                        j + xStart < canvas[0].size() &&
-                        j + xStart >= 0
-                        )
-                    canvas[i + yStart][j + xStart] = menuItems[i][j];
-            }
+        for (size_t i = 0; i < menuItems.size(); i++) {
+            const ptrdiff_t y = yStart + static_cast<ptrdiff_t>(i);
+            if (y < 0 || y >= static_cast<ptrdiff_t>(canvas.size())) continue;
+            const TextLayout::Span line = menuItems[i];
+            const ptrdiff_t from = max<ptrdiff_t>(0, -xStart);
+            const ptrdiff_t to = min<ptrdiff_t>(static_cast<ptrdiff_t>(line.size()),
+                                                static_cast<ptrdiff_t>(canvas[y].size()) - xStart);
+            if (from < to) memcpy(canvas[y].data() + xStart + from, line.data + from, to - from);
         }
     }
     virtual void fillMenuItems() {};
-private:
     virtual void calculateCords() {
-        yStart = (SCREEN_HEIGHT - menuItems.size()) / 2;
-        xStart = (SCREEN_WIDTH - menuItems[1].size()) / 2;
+        yStart = (SCREEN_HEIGHT - static_cast<ptrdiff_t>(menuItems.size())) / 2;
+        xStart = (SCREEN_WIDTH - static_cast<ptrdiff_t>(menuItems[1].size())) / 2;
     }
 };
 class Menu : public Screen {
 protected:
     void fillMenuItems() override {
-        menuItems = {
+        menuItems.assign({
                 "Menu         ",
                 "1.  Table    ",
                 "2.  Graphics ",
@@ -186,18 +289,16 @@ protected:
                 "5.  Animation",
                 "6.  Author   ",
                 "7.  Exit     ",
-        };
+        });
     }
 private:
     int point = 1;
-    size_t yPoint;
-    size_t xPoint;
+    ptrdiff_t yPoint;
+    ptrdiff_t xPoint;
 public:
     Menu() {
         configureScreen();
-        yPoint = yStart + point;
-        xPoint = xStart - 2;
-        canvas[yPoint][xPoint] = '*';
+        placePoint();
     }
     void render() override {
         switch (Buttons::getKeyCode()) {
@@ -226,12 +327,25 @@ public:
         else point = 7;
         update();
     }
+protected:
+    void relayout() override {
+        Screen::relayout();
+        placePoint();
+    }
 private:
+    [[nodiscard]] bool pointInCanvas() const {
+        return yPoint >= 0 && yPoint < static_cast<ptrdiff_t>(canvas.size()) &&
+               xPoint >= 0 && xPoint < static_cast<ptrdiff_t>(canvas[0].size());
+    }
+    void placePoint() {
+        yPoint = yStart + point;
+        xPoint = xStart - 2;
+        if (pointInCanvas()) canvas[yPoint][xPoint] = '*';
+    }
     void checkPointPosition() {
         if (yStart + point != yPoint) {
-            canvas[yPoint][xPoint] = ' ';
-            yPoint = yStart + point;
-            canvas[yPoint][xPoint] = '*';
+            if (pointInCanvas()) canvas[yPoint][xPoint] = ' ';
+            placePoint();
         }
     }
 };
@@ -248,27 +362,27 @@ protected:
         double maxF2 = findMax(XF1F2[2]);
         double minF1 = findMin(XF1F2[1]);
         double minF2 = findMin(XF1F2[2]);
-        menuItems = {
+        menuItems.assign({
                 "____________________________________________",
                 "|   i    |   x[i]  |    F1[i]  |    F2[i]  |",
                 "|________|_________|___________|___________|",
-        };
+        });
         for (int i = 0; i < N; i++) {
-            menuItems.emplace_back("|        |        |            |           |");
-            sprintf(menuItems[i + 3].data(), "|   %-2d   | %#7.5f | %#9g | %#9g |", i+1, XF1F2[0][i], XF1F2[1][i],
+            menuItems.addLine("|        |        |            |           |");
+            menuItems.print(i + 3, 0, "|   %-2d   | %#7.5f | %#9g | %#9g |", i+1, XF1F2[0][i], XF1F2[1][i],
                     XF1F2[2][i]);
-            menuItems[i + 3][21] = (XF1F2[1][i] == maxF1) ? Color::GREEN : (XF1F2[1][i] == minF1) ? Color::MAGENTA
-                                                                                                  : ' ';
-            menuItems[i + 3][30] = Color::RESET;
-            menuItems[i + 3][33] = (XF1F2[2][i] == maxF2) ? Color::GREEN : (XF1F2[2][i] == minF2) ? Color::MAGENTA
-                                                                                                  : ' ';
-            menuItems[i + 3][42] = Color::RESET;
+            menuItems.put(i + 3, 21, (XF1F2[1][i] == maxF1) ? Color::GREEN : (XF1F2[1][i] == minF1) ? Color::MAGENTA
+                                                                                                    : ' ');
+            menuItems.put(i + 3, 30, Color::RESET);
+            menuItems.put(i + 3, 33, (XF1F2[2][i] == maxF2) ? Color::GREEN : (XF1F2[2][i] == minF2) ? Color::MAGENTA
+                                                                                                    : ' ');
+            menuItems.put(i + 3, 42, Color::RESET);
         }
-        menuItems.emplace_back("|__________________________________________|");
-        menuItems.emplace_back(";Max F1: " + to_string(maxF1));
-        menuItems.emplace_back(" Max F2: " + to_string(maxF2) + "%");
-        menuItems.emplace_back("?Min F1: " + to_string(minF1));
-        menuItems.emplace_back(" Min F2: " + to_string(minF2) + "%");
+        menuItems.addLine("|__________________________________________|");
+        menuItems.addFormat(";Max F1: %f", maxF1);
+        menuItems.addFormat(" Max F2: %f%%", maxF2);
+        menuItems.addFormat("?Min F1: %f", minF1);
+        menuItems.addFormat(" Min F2: %f%%", minF2);
     }
 private:
     const double dX = fabs(B - A) / (N - 1.0);
@@ -334,7 +448,7 @@ public:
         }
     }
     void update() override {
-        canvas = generateCanvas();
+        resizeCanvas(canvas);
         drawCoordinates();
         drawGraphic();
         drawFunctionsNames();
@@ -343,10 +457,14 @@ public:
     }
 protected:
     void fillMenuItems() override {
-        menuItems = {" "};
+        menuItems.assign({" "});
+    }
+    void relayout() override {
+        resizeCanvas(canvas); // plot is redrawn from scratch on every update()
     }
 private:
     void drawCordNames() {
+        if (SCREEN_HEIGHT < 2 || SCREEN_WIDTH < 3) return;
         canvas[SCREEN_HEIGHT / 2 - 1][SCREEN_WIDTH - 1] = 'X';
         canvas[0][SCREEN_WIDTH / 2 + 1] = 'Y';
     }
@@ -361,12 +479,14 @@ private:
         update();
     }
     void drawFunctionsNames() {
+        if (SCREEN_HEIGHT < 2 || SCREEN_WIDTH < static_cast<int>(functionsNames[0].size())) return;
         for (int x = 0; x < functionsNames[0].size() - 1; ++x) {
             canvas[0][SCREEN_WIDTH - functionsNames[0].size() + x] = functionsNames[0][x];
             canvas[1][SCREEN_WIDTH - functionsNames[0].size() + x] = functionsNames[1][x];
         }
     }
     void drawCoordinates() {
+        if (SCREEN_HEIGHT < 1 || SCREEN_WIDTH < 1) return;
         for (int x = 0; x < SCREEN_WIDTH; ++x) canvas[SCREEN_HEIGHT / 2][x] = '-';
         for (int y = 0; y < SCREEN_HEIGHT; ++y) canvas[y][SCREEN_WIDTH / 2] = '|';
         canvas[SCREEN_HEIGHT / 2][SCREEN_WIDTH / 2] = '+';
@@ -430,7 +550,7 @@ public:
 
 protected:
     void fillMenuItems() override {
-        menuItems = {
+        menuItems.assign({
                 "____________________________________________________",
                 "| Equation x^3 + 3x + 2 = 0 on the segment[   ,   ]|",
                 "----------------------------------------------------",
@@ -440,10 +560,10 @@ protected:
                 "----------------------------------------------------",
                 "| Chords method:                                   |",
                 "----------------------------------------------------",
-        };
-        sprintf(menuItems[1].data(), "| Equation x^3 + 3x + 2 = 0 on the segment[%3d,%3d]|", A, B);
-        sprintf(menuItems[4].data(), "| Bisection method:                     %8f  |", bisectionMethod());
-        sprintf(menuItems[7].data(), "| Chords method:                        %8f  |", chordsMethod());
+        });
+        menuItems.print(1, 0, "| Equation x^3 + 3x + 2 = 0 on the segment[%3d,%3d]|", A, B);
+        menuItems.print(4, 0, "| Bisection method:                     %8f  |", bisectionMethod());
+        menuItems.print(7, 0, "| Chords method:                        %8f  |", chordsMethod());
     }
 private:
     [[nodiscard]] double bisectionMethod() const {
@@ -482,7 +602,7 @@ private:
     bool opened = true;
 protected:
     void fillMenuItems() override {
-        menuItems = {
+        menuItems.assign({
                 "---------------------------------------------",
                 "| cos(x) * pow(e, x) on the segment[   ,   ]|",
                 "---------------------------------------------",
@@ -501,14 +621,14 @@ protected:
                 "---------------------------------------------",
                 "| Middle Rectangle method:                  |",
                 "---------------------------------------------",
-                "  e = " + to_string(e),
-        };
-        sprintf(menuItems[1].data(), "| cos(x) * pow(e, x) on the segment[%3d,%3d]|", A, B);
-        sprintf(menuItems[4].data(),  "| Right Rectangle method:  %8f", rectangleMethod());
-        sprintf(menuItems[7].data(), "| Trapeze method:           %8f", trapezeMethod());
-        sprintf(menuItems[10].data(), "| Gauss method:            %8f", gaussMethod());
-        sprintf(menuItems[13].data(), "| Monte Carlo method:      %8f", monteCarloMethod());
-        sprintf(menuItems[16].data(), "| Middle Rectangle method: %8f", midRectangleMethod());
+        });
+        menuItems.addFormat("  e = %f", e);
+        menuItems.print(1, 0, "| cos(x) * pow(e, x) on the segment[%3d,%3d]|", A, B);
+        menuItems.print(4, 0, "| Right Rectangle method:  %8f", rectangleMethod());
+        menuItems.print(7, 0, "| Trapeze method:           %8f", trapezeMethod());
+        menuItems.print(10, 0, "| Gauss method:            %8f", gaussMethod());
+        menuItems.print(13, 0, "| Monte Carlo method:      %8f", monteCarloMethod());
+        menuItems.print(16, 0, "| Middle Rectangle method: %8f", midRectangleMethod());
     }
     const double H = fabs(B - A) / N;
 public:
@@ -588,16 +708,16 @@ class Animation : public Screen {
 
 private:
     void fillMenuItems() override {
-        menuItems = {
+        menuItems.assign({
                 " _________________________    ",
                 "|   |     |     |    | |  \\  ",
                 "|___|_____|_____|____|_|___\\ ",
                 "|                    | |    \\",
                 "`--(o)(o)--------------(o)--' ",
-        };
+        });
     }
     const int delay = 10;
-    const vector<vector<char>> voidCanvas = generateCanvas();
+    vector<vector<char>> voidCanvas = generateCanvas();
 
 public:
     Animation() {
@@ -614,17 +734,25 @@ public:
         }
         Screen::render();
     }
+protected:
+    void relayout() override {
+        resizeCanvas(canvas);
+        resizeCanvas(voidCanvas);
+        const auto x = xStart;
+        calculateCords();
+        xStart = x; // the car keeps its position
+    }
 private:
     void moveDrawing() {
-        if (xStart < SCREEN_WIDTH - 1 || xStart > 0 - menuItems[0].size() - 1) xStart++;
-        else xStart = 0 - menuItems[0].size();
+        if (xStart < SCREEN_WIDTH - 1) xStart++;
+        else xStart = -static_cast<ptrdiff_t>(menuItems[0].size());
         drawMenuItems();
     }
 };
 class Author : public Screen {
 protected:
     void fillMenuItems() override {
-        menuItems = {
+        menuItems.assign({
                 R"(;/ \ / \ / \ / \ / \ / \ / \ / \ / \ / \ / \ / \    %)",
                 "?RGR for programming                                       ",
                 " University: OmSTU                                         ",
@@ -632,26 +760,61 @@ protected:
                 " Group: PI-232                                             ",
                 " pistrunov pistrun pistrunovich                           %",
                 R"(;\ / \ / \ / \ / \ / \ / \ / \ / \ / \ / \ / \ /    %)",
-        };
+        });
     }
 public:
     Author() {
         configureScreen();
     }
 };
-static void configure() {
-    ios::sync_with_stdio(false);
-    cin.tie(nullptr);
+static void readScreenSize() {
 #ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
-    SCREEN_HEIGHT = csbi.srWindow.Bottom - csbi.srWindow.Top;
-    SCREEN_WIDTH = csbi.srWindow.Right - csbi.srWindow.Left;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi)) return; // keep the previous size
+    SCREEN_HEIGHT = max(csbi.srWindow.Bottom - csbi.srWindow.Top, 0);
+    SCREEN_WIDTH = max(csbi.srWindow.Right - csbi.srWindow.Left, 0);
 #else
     struct winsize size{};
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &size);
-    SCREEN_HEIGHT = size.ws_row - 1;
-    SCREEN_WIDTH = size.ws_col;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == -1) return; // keep the previous size
+    SCREEN_HEIGHT = max(size.ws_row - 1, 0);
+    SCREEN_WIDTH = max<int>(size.ws_col, 0);
+#endif
+}
+#ifndef _WIN32
+static void onResize(int) {
+    terminalResized = 1;
+}
+#endif
+/* Returns true once per terminal resize, after SCREEN_WIDTH and SCREEN_HEIGHT are updated */
+static bool consumeResize() {
+#ifdef _WIN32
+    const int oldHeight = SCREEN_HEIGHT, oldWidth = SCREEN_WIDTH;
+    readScreenSize();
+    if (SCREEN_HEIGHT == oldHeight && SCREEN_WIDTH == oldWidth) return false;
+#else
+    if (!terminalResized) return false;
+    terminalResized = 0;
+    readScreenSize();
+#endif
+    layoutGeneration++;
+    return true;
+}
+static void configure() {
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+    readScreenSize();
+#ifndef _WIN32
+    struct sigaction action{};
+    action.sa_handler = onResize;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, nullptr);
+    // SIGWINCH is only delivered inside getch()'s pselect(), so a resize during a redraw is never lost
+    sigset_t resizeMask;
+    sigemptyset(&resizeMask);
+    sigaddset(&resizeMask, SIGWINCH);
+    sigprocmask(SIG_BLOCK, &resizeMask, &resizeWaitMask);
+    sigdelset(&resizeWaitMask, SIGWINCH);
+    setvbuf(stdin, nullptr, _IONBF, 0); // pselect() must not miss keys already buffered by stdio
 #endif
 }
 int main() {
@@ -666,7 +829,9 @@ int main() {
     screens[6] = new Author;
     ScreenIds preId = ScreenIds::TABLE;
     while (screenId != ScreenIds::EXIT) {
-        if (screenId != preId) {
+        const bool resized = consumeResize();
+        if (screenId != preId || resized) {
+            screens[screenId]->refreshLayout();
             screens[screenId]->update();
             preId = screenId;
         }